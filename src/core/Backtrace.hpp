@@ -0,0 +1,396 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+extern "C" {
+extern std::uint32_t const __exidx_start[];
+extern std::uint32_t const __exidx_end[];
+}
+
+namespace Kvasir::Core::Fault {
+
+enum class UnwindMethod : std::uint8_t { Exidx, FramePointer };
+
+enum class UnwindStop : std::uint8_t {
+    MaxDepth,
+    BadFrame,
+    BadMemory,
+    NoEntry,
+    CantUnwind,
+    Unsupported,
+    NoProgress,
+    ExceptionReturn
+};
+
+template<std::size_t MaxDepth>
+struct Backtrace {
+    std::array<std::uint32_t, MaxDepth> addresses{};
+    std::size_t                         depth{};
+    UnwindStop                          stop{UnwindStop::MaxDepth};
+};
+
+// On-target memory access for the unwinder. Every load is range and alignment checked so
+// a corrupt stack pointer or frame cannot fault again inside HardFault.
+// needed bounds
+// stackBegin() stackEnd()
+// codeBegin() codeEnd()
+template<typename Bounds>
+struct TargetMemory {
+    static std::optional<std::uint32_t> loadStack(std::uint32_t addr) {
+        return load(addr, Bounds::stackBegin(), Bounds::stackEnd());
+    }
+
+    static std::optional<std::uint32_t> loadCode(std::uint32_t addr) {
+        return load(addr, Bounds::codeBegin(), Bounds::codeEnd());
+    }
+
+    static std::uint32_t exidxBegin() {
+        return static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(__exidx_start));
+    }
+
+    static std::uint32_t exidxEnd() {
+        return static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(__exidx_end));
+    }
+
+private:
+    static std::optional<std::uint32_t> load(std::uint32_t addr,
+                                             std::uint32_t begin,
+                                             std::uint32_t end) {
+        if((addr & 3U) != 0 || addr < begin || addr >= end || end - addr < 4) {
+            return std::nullopt;
+        }
+        return *reinterpret_cast<std::uint32_t const volatile*>(std::uintptr_t{addr});
+    }
+};
+
+// Fixed depth, allocation free stack unwinder usable from HardFault.
+// needed config
+// maxDepth
+// method
+// loadStack(addr) -> std::optional<std::uint32_t>
+// loadCode(addr) -> std::optional<std::uint32_t>
+// exidxBegin() exidxEnd()
+// Replaying a captured stack image on the host only needs a config whose loads read from
+// the image instead of target memory.
+template<typename TConfig>
+struct Unwinder {
+private:
+    using Config                              = TConfig;
+    static constexpr std::size_t  MaxDepth    = Config::maxDepth;
+    static constexpr std::size_t  MaxOpcodes  = 1024;
+    static constexpr std::uint32_t CantUnwind = 1;
+
+    enum : std::size_t { R7 = 7, SP = 13, LR = 14, PC = 15 };
+
+    struct Registers {
+        std::array<std::uint32_t, 16> r{};
+        std::uint16_t                 valid{};
+
+        void set(std::size_t   i,
+                 std::uint32_t v) {
+            r[i] = v;
+            valid |= std::uint16_t(1U << i);
+        }
+
+        [[nodiscard]] bool has(std::size_t i) const { return (valid & (1U << i)) != 0; }
+    };
+
+    // prel31 relative to the word at addr
+    static constexpr std::uint32_t prel31(std::uint32_t addr,
+                                          std::uint32_t word) {
+        std::uint32_t const offset = (word & 0x4000'0000U) != 0 ? word | 0x8000'0000U
+                                                                : word & 0x7FFF'FFFFU;
+        return addr + offset;
+    }
+
+    // Opcode bytes of one unwind entry, fetched lazily, most significant byte first.
+    struct OpcodeStream {
+        std::uint32_t word;
+        std::uint32_t nextWordAddr;
+        std::size_t   bytesInWord;
+        std::size_t   wordsLeft;
+
+        std::optional<std::uint8_t> next() {
+            if(bytesInWord == 0) {
+                if(wordsLeft == 0) { return std::uint8_t{0xB0}; }   // implicit finish
+                auto const w = Config::loadCode(nextWordAddr);
+                if(!w) { return std::nullopt; }
+                word = *w;
+                nextWordAddr += 4;
+                --wordsLeft;
+                bytesInWord = 4;
+            }
+            --bytesInWord;
+            return std::uint8_t(word >> (bytesInWord * 8));
+        }
+    };
+
+    // Largest table entry whose function start is <= pc.
+    static std::optional<std::uint32_t> findEntry(std::uint32_t pc) {
+        std::uint32_t const begin = Config::exidxBegin();
+        std::uint32_t const end   = Config::exidxEnd();
+        if(end <= begin) { return std::nullopt; }
+        std::uint32_t lo = 0;
+        std::uint32_t hi = (end - begin) / 8;
+        std::optional<std::uint32_t> found;
+        while(lo < hi) {
+            std::uint32_t const mid   = lo + (hi - lo) / 2;
+            std::uint32_t const entry = begin + mid * 8;
+            auto const          w     = Config::loadCode(entry);
+            if(!w) { return std::nullopt; }
+            if(prel31(entry, *w) <= pc) {
+                found = entry;
+                lo    = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return found;
+    }
+
+    static std::optional<UnwindStop> makeStream(std::uint32_t entry,
+                                                OpcodeStream& s) {
+        auto const w = Config::loadCode(entry + 4);
+        if(!w) { return UnwindStop::BadMemory; }
+        if(*w == CantUnwind) { return UnwindStop::CantUnwind; }
+
+        if((*w & 0x8000'0000U) != 0) {
+            // inline compact model 0, three opcode bytes
+            if(((*w >> 24) & 0xFU) != 0) { return UnwindStop::Unsupported; }
+            s = OpcodeStream{*w, 0, 3, 0};
+            return std::nullopt;
+        }
+
+        std::uint32_t const table = prel31(entry + 4, *w);
+        auto const          h     = Config::loadCode(table);
+        if(!h) { return UnwindStop::BadMemory; }
+
+        if((*h & 0x8000'0000U) != 0) {
+            switch((*h >> 24) & 0xFU) {
+            case 0: s = OpcodeStream{*h, 0, 3, 0}; return std::nullopt;
+            case 1:
+            case 2: s = OpcodeStream{*h, table + 4, 2, (*h >> 16) & 0xFFU}; return std::nullopt;
+            default: return UnwindStop::Unsupported;
+            }
+        }
+
+        // generic personality routine followed by a compact model 1 style word
+        auto const d = Config::loadCode(table + 4);
+        if(!d) { return UnwindStop::BadMemory; }
+        s = OpcodeStream{*d, table + 8, 3, (*d >> 24) & 0xFFU};
+        return std::nullopt;
+    }
+
+    static bool pop(Registers&    regs,
+                    std::uint32_t mask) {
+        std::uint32_t vsp = regs.r[SP];
+        std::uint32_t sp  = regs.r[SP];
+        for(std::size_t i = 0; i < 16; ++i) {
+            if((mask & (1U << i)) == 0) { continue; }
+            auto const v = Config::loadStack(vsp);
+            if(!v) { return false; }
+            if(i == SP) {
+                sp = *v;
+            } else {
+                regs.set(i, *v);
+            }
+            vsp += 4;
+        }
+        // a popped sp replaces the incremented one
+        regs.r[SP] = (mask & (1U << SP)) != 0 ? sp : vsp;
+        return true;
+    }
+
+    // Executes the EHABI unwind opcodes for one frame, see ARM IHI 0038 section 10.3.
+    static std::optional<UnwindStop> execute(OpcodeStream& s,
+                                             Registers&    regs) {
+        bool pcSet{};
+        for(std::size_t n = 0; n < MaxOpcodes; ++n) {
+            auto const op = s.next();
+            if(!op) { return UnwindStop::BadMemory; }
+            std::uint8_t const b = *op;
+
+            if((b & 0xC0U) == 0x00U) {
+                regs.r[SP] += ((b & 0x3FU) << 2U) + 4U;
+            } else if((b & 0xC0U) == 0x40U) {
+                regs.r[SP] -= ((b & 0x3FU) << 2U) + 4U;
+            } else if((b & 0xF0U) == 0x80U) {
+                auto const b2 = s.next();
+                if(!b2) { return UnwindStop::BadMemory; }
+                std::uint32_t const mask = ((std::uint32_t(b & 0x0FU) << 8U) | *b2) << 4U;
+                if(mask == 0) { return UnwindStop::CantUnwind; }
+                if(!pop(regs, mask)) { return UnwindStop::BadMemory; }
+                pcSet = pcSet || (mask & (1U << PC)) != 0;
+            } else if((b & 0xF0U) == 0x90U) {
+                std::size_t const reg = b & 0x0FU;
+                if(reg == SP || reg == PC || !regs.has(reg)) { return UnwindStop::Unsupported; }
+                regs.r[SP] = regs.r[reg];
+            } else if((b & 0xF0U) == 0xA0U) {
+                std::uint32_t mask = ((1U << ((b & 0x07U) + 1U)) - 1U) << 4U;
+                if((b & 0x08U) != 0) { mask |= 1U << LR; }
+                if(!pop(regs, mask)) { return UnwindStop::BadMemory; }
+            } else if(b == 0xB0U) {
+                break;
+            } else if(b == 0xB1U) {
+                auto const b2 = s.next();
+                if(!b2 || *b2 == 0 || (*b2 & 0xF0U) != 0) { return UnwindStop::Unsupported; }
+                if(!pop(regs, *b2)) { return UnwindStop::BadMemory; }
+            } else if(b == 0xB2U) {
+                std::uint32_t uleb{};
+                for(std::uint32_t shift = 0;; shift += 7) {
+                    auto const b2 = s.next();
+                    if(!b2 || shift > 28) { return UnwindStop::BadMemory; }
+                    uleb |= std::uint32_t(*b2 & 0x7FU) << shift;
+                    if((*b2 & 0x80U) == 0) { break; }
+                }
+                regs.r[SP] += 0x204U + (uleb << 2U);
+            } else if(b == 0xB3U || b == 0xC8U || b == 0xC9U) {
+                auto const b2 = s.next();
+                if(!b2) { return UnwindStop::BadMemory; }
+                // FSTMFDX (0xB3) stores one extra format word
+                regs.r[SP] += 8U * ((*b2 & 0x0FU) + 1U) + (b == 0xB3U ? 4U : 0U);
+            } else if((b & 0xF8U) == 0xB8U) {
+                regs.r[SP] += 8U * ((b & 0x07U) + 1U) + 4U;
+            } else if((b & 0xF8U) == 0xD0U) {
+                regs.r[SP] += 8U * ((b & 0x07U) + 1U);
+            } else {
+                // iWMMXt and reserved opcodes do not occur on v8-M
+                return UnwindStop::Unsupported;
+            }
+        }
+        if(!pcSet) {
+            if(!regs.has(LR)) { return UnwindStop::BadFrame; }
+            regs.set(PC, regs.r[LR]);
+        }
+        return std::nullopt;
+    }
+
+    static std::optional<UnwindStop> stepExidx(Registers& regs,
+                                               bool       returnAddress) {
+        // a return address points behind the call which may be the last instruction
+        std::uint32_t const lookup = (regs.r[PC] & ~1U) - (returnAddress ? 2U : 0U);
+        auto const          entry  = findEntry(lookup);
+        if(!entry) { return UnwindStop::NoEntry; }
+        OpcodeStream s{};
+        if(auto const stop = makeStream(*entry, s)) { return stop; }
+        return execute(s, regs);
+    }
+
+    static std::optional<UnwindStop> stepFramePointer(Registers& regs) {
+        if(!regs.has(R7)) { return UnwindStop::BadFrame; }
+        std::uint32_t const fp   = regs.r[R7];
+        auto const          prev = Config::loadStack(fp);
+        auto const          lr   = Config::loadStack(fp + 4);
+        if(!prev || !lr) { return UnwindStop::BadMemory; }
+        regs.set(R7, *prev);
+        regs.set(PC, *lr);
+        regs.r[SP] = fp + 8;
+        return std::nullopt;
+    }
+
+    static void walk(Registers&               regs,
+                     Backtrace<MaxDepth>&     trace) {
+        for(bool returnAddress = false; trace.depth < MaxDepth; returnAddress = true) {
+            std::uint32_t const pc = regs.r[PC];
+            if((pc & 0xFF00'0000U) == 0xFF00'0000U) {
+                trace.stop = UnwindStop::ExceptionReturn;
+                return;
+            }
+            if(pc == 0) {
+                trace.stop = UnwindStop::BadFrame;
+                return;
+            }
+            trace.addresses[trace.depth] = pc & ~1U;
+            ++trace.depth;
+            if(trace.depth == MaxDepth) { break; }
+
+            std::uint32_t const sp = regs.r[SP];
+            auto const stop = Config::method == UnwindMethod::FramePointer
+                              ? stepFramePointer(regs)
+                              : stepExidx(regs, returnAddress);
+            if(stop) {
+                trace.stop = *stop;
+                return;
+            }
+            // the stack only grows towards lower addresses, anything else is a loop
+            if(regs.r[SP] < sp || (regs.r[SP] == sp && regs.r[PC] == pc)) {
+                trace.stop = UnwindStop::NoProgress;
+                return;
+            }
+        }
+        trace.stop = UnwindStop::MaxDepth;
+    }
+
+public:
+    // Unwinds from an exception. excReturn is the LR value on handler entry, msp/psp the
+    // stack pointers as they were when the exception was taken and r7 the live frame pointer.
+    static Backtrace<MaxDepth> fromException(std::uint32_t excReturn,
+                                             std::uint32_t msp,
+                                             std::uint32_t psp,
+                                             std::uint32_t r7) {
+        Backtrace<MaxDepth> trace{};
+        Registers           regs{};
+
+        // EXC_RETURN.SPSEL
+        std::uint32_t frame = (excReturn & (1U << 2)) != 0 ? psp : msp;
+
+        // EXC_RETURN.DCRS == 0: integrity signature, reserved word and r4-r11 come first
+        if((excReturn & (1U << 5)) == 0) {
+            for(std::size_t i = 0; i < 8; ++i) {
+                auto const v = Config::loadStack(frame + 8 + 4 * i);
+                if(!v) {
+                    trace.stop = UnwindStop::BadMemory;
+                    return trace;
+                }
+                regs.set(4 + i, *v);
+            }
+            frame += 40;
+        } else {
+            regs.set(R7, r7);
+        }
+
+        static constexpr std::array<std::size_t, 7> stacked{0, 1, 2, 3, 12, LR, PC};
+        for(std::size_t i = 0; i < stacked.size(); ++i) {
+            auto const v = Config::loadStack(frame + 4 * i);
+            if(!v) {
+                trace.stop = UnwindStop::BadMemory;
+                return trace;
+            }
+            regs.set(stacked[i], *v);
+        }
+        auto const xpsr = Config::loadStack(frame + 28);
+        if(!xpsr) {
+            trace.stop = UnwindStop::BadMemory;
+            return trace;
+        }
+
+        // EXC_RETURN.FType == 0: S0-S15, FPSCR and a reserved word follow the basic frame
+        std::uint32_t const frameSize = (excReturn & (1U << 4)) != 0 ? 32U : 104U;
+        // xPSR bit 9: one padding word was inserted to 8 byte align the frame
+        std::uint32_t const padding   = (*xpsr & (1U << 9)) != 0 ? 4U : 0U;
+        regs.set(SP, frame + frameSize + padding);
+
+        walk(regs, trace);
+        return trace;
+    }
+
+    // Unwinds from a known register state, e.g. the caller of this function.
+    static Backtrace<MaxDepth> fromState(std::uint32_t pc,
+                                         std::uint32_t lr,
+                                         std::uint32_t sp,
+                                         std::uint32_t r7) {
+        Backtrace<MaxDepth> trace{};
+        Registers           regs{};
+        regs.set(PC, pc);
+        regs.set(LR, lr);
+        regs.set(SP, sp);
+        regs.set(R7, r7);
+        walk(regs, trace);
+        return trace;
+    }
+};
+
+}   // namespace Kvasir::Core::Fault
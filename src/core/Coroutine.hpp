@@ -0,0 +1,269 @@
+#pragma once
+
+#include "Nvic.hpp"
+#include "kvasir/Common/Interrupt.hpp"
+#include "kvasir/Register/Register.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+namespace Kvasir::Core::Coroutine {
+
+// Fixed pool of equally sized coroutine frames. Frames are handed out and returned from
+// thread context only (coroutine creation and Runtime::poll), never from an ISR.
+template<std::size_t FrameSize,
+         std::size_t FrameCount>
+struct FramePool {
+    static_assert(FrameCount != 0, "pool needs at least one frame");
+
+    static void* allocate(std::size_t size) noexcept {
+        if(size > FrameSize) { return nullptr; }
+        for(std::size_t i = 0; i < FrameCount; ++i) {
+            if(!used[i]) {
+                used[i] = true;
+                return storage[i].bytes.data();
+            }
+        }
+        return nullptr;
+    }
+
+    static void deallocate(void* p) noexcept {
+        for(std::size_t i = 0; i < FrameCount; ++i) {
+            if(storage[i].bytes.data() == p) {
+                used[i] = false;
+                return;
+            }
+        }
+    }
+
+    [[nodiscard]] static std::size_t available() noexcept {
+        std::size_t n{};
+        for(bool const u : used) {
+            if(!u) { ++n; }
+        }
+        return n;
+    }
+
+private:
+    // aligned per element, so every frame and not only the first one meets operator new's
+    // alignment guarantee
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Frame {
+        std::array<std::byte, FrameSize> bytes;
+    };
+
+    static inline std::array<Frame, FrameCount> storage{};
+    static inline std::array<bool, FrameCount>  used{};
+};
+
+namespace detail {
+    // One waiter per interrupt line. The ISR disables the line again so a level triggered
+    // source does not re-enter before the resumed coroutine had a chance to service it.
+    template<int I>
+        requires(I >= 0)
+    struct InterruptSlot {
+        static inline std::atomic<std::atomic<bool>*> waiter{};
+
+        static void onIsr() {
+            apply(makeDisable(Nvic::Index<I>{}));
+            if(auto* const ready = waiter.exchange(nullptr, std::memory_order_acquire);
+               ready != nullptr)
+            {
+                ready->store(true, std::memory_order_release);
+            }
+        }
+    };
+}   // namespace detail
+
+template<int I>
+    requires(I >= 0)
+struct InterruptAwaiter {
+    bool acquired{};
+
+    static constexpr bool await_ready() noexcept { return false; }
+
+    // Does not suspend if another coroutine already waits on this line.
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> h) noexcept {
+        std::atomic<bool>* expected{};
+        h.promise().ready.store(false, std::memory_order_relaxed);
+        acquired = detail::InterruptSlot<I>::waiter.compare_exchange_strong(
+          expected,
+          std::addressof(h.promise().ready),
+          std::memory_order_release,
+          std::memory_order_relaxed);
+        if(!acquired) { return false; }
+        apply(makeEnable(Nvic::Index<I>{}));
+        return true;
+    }
+
+    // false if the line was already taken and the coroutine resumed without an interrupt
+    [[nodiscard]] constexpr bool await_resume() const noexcept { return acquired; }
+};
+
+template<typename TimePoint>
+struct DeadlineAwaiter {
+    TimePoint deadline;
+
+    [[nodiscard]] bool await_ready() const noexcept {
+        return TimePoint::clock::now() >= deadline;
+    }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> h) const noexcept {
+        h.promise().sleepUntil(deadline);
+    }
+
+    static constexpr void await_resume() noexcept {}
+};
+
+// co_await interrupt(Interrupt::x) resumes on the next occurrence of x.
+// The line is enabled while waiting and disabled again by Isr<x>::isr, which has to be
+// registered like any other driver isr. Only one coroutine can wait on a line at a time, a
+// second one resumes immediately and the co_await yields false. Only NVIC lines can be
+// awaited, core exceptions like systick belong to their drivers.
+template<int I>
+    requires(I >= 0)
+[[nodiscard]] constexpr InterruptAwaiter<I> interrupt(Nvic::Index<I>) {
+    return {};
+}
+
+// co_await until(t) resumes once Clock::now() >= t.
+template<typename Clock,
+         typename Duration>
+[[nodiscard]] constexpr DeadlineAwaiter<std::chrono::time_point<Clock, Duration>>
+until(std::chrono::time_point<Clock, Duration> deadline) {
+    return {deadline};
+}
+
+template<int I>
+    requires(I >= 0)
+struct Isr {
+    static constexpr Nvic::Isr<std::addressof(detail::InterruptSlot<I>::onIsr), Nvic::Index<I>>
+      isr{};
+};
+
+template<typename TConfig>
+struct Runtime {
+private:
+    // needed config
+    // Clock
+    // frameSize
+    // frameCount
+    using Config     = TConfig;
+    using Clock      = typename Config::Clock;
+    using time_point = typename Clock::time_point;
+    using Pool       = FramePool<Config::frameSize, Config::frameCount>;
+
+public:
+    struct Promise;
+    using Handle = std::coroutine_handle<Promise>;
+
+    // Fire and forget: the coroutine is owned by the runtime and destroyed when it finishes.
+    // A Task converting to false could not get a frame from the pool and never runs.
+    struct Task {
+        using promise_type = Promise;
+
+        bool valid;
+
+        explicit constexpr operator bool() const { return valid; }
+    };
+
+    struct Promise {
+        std::atomic<bool> ready{true};
+        bool              sleeping{};
+        time_point        deadline{};
+        Promise*          next{};
+
+        Promise() { link(this); }
+
+        static void* operator new(std::size_t size) noexcept { return Pool::allocate(size); }
+
+        static void operator delete(void* p) noexcept { Pool::deallocate(p); }
+
+        static Task get_return_object_on_allocation_failure() noexcept { return Task{false}; }
+
+        Task get_return_object() noexcept { return Task{true}; }
+
+        static constexpr std::suspend_always initial_suspend() noexcept { return {}; }
+
+        static constexpr std::suspend_always final_suspend() noexcept { return {}; }
+
+        static constexpr void return_void() noexcept {}
+
+        [[noreturn]] static void unhandled_exception() noexcept { std::terminate(); }
+
+        void sleepUntil(time_point t) noexcept {
+            ready.store(false, std::memory_order_relaxed);
+            deadline = t;
+            sleeping = true;
+        }
+    };
+
+    // Resumes every coroutine that is ready or whose deadline has passed and frees the frames
+    // of finished ones. Returns false if nothing ran. Deadlines are only checked here, so the
+    // caller may only sleep until the next interrupt if nextDeadline() is empty as well;
+    // otherwise it has to keep polling or arm a wakeup for that deadline.
+    static bool poll() {
+        while(spawned != nullptr) {
+            Promise* const p = spawned;
+            spawned          = p->next;
+            p->next          = tasks;
+            tasks            = p;
+        }
+
+        bool      ran{};
+        Promise** cur = std::addressof(tasks);
+        while(*cur != nullptr) {
+            Promise& p = **cur;
+            if(p.sleeping && Clock::now() >= p.deadline) {
+                p.sleeping = false;
+                p.ready.store(true, std::memory_order_relaxed);
+            }
+            if(p.ready.exchange(false, std::memory_order_acquire)) {
+                auto const h = Handle::from_promise(p);
+                h.resume();
+                ran = true;
+                if(h.done()) {
+                    *cur = p.next;
+                    h.destroy();
+                    continue;
+                }
+            }
+            cur = std::addressof(p.next);
+        }
+        return ran;
+    }
+
+    [[nodiscard]] static bool idle() { return tasks == nullptr && spawned == nullptr; }
+
+    // Earliest deadline of all coroutines waiting in until().
+    [[nodiscard]] static std::optional<time_point> nextDeadline() {
+        std::optional<time_point> next;
+        for(Promise const* p = tasks; p != nullptr; p = p->next) {
+            if(p->sleeping && (!next || p->deadline < *next)) { next = p->deadline; }
+        }
+        return next;
+    }
+
+private:
+    static inline Promise* tasks{};
+    // coroutines created since the last poll, kept apart so spawning from inside a running
+    // coroutine does not modify the list poll is walking
+    static inline Promise* spawned{};
+
+    static void link(Promise* p) {
+        p->next = spawned;
+        spawned = p;
+    }
+};
+
+}   // namespace Kvasir::Core::Coroutine
@@ -1,10 +1,14 @@
 #pragma once
 #include "core_peripherals/DCB.hpp"
+#include "core_peripherals/DWT.hpp"
 #include "kvasir/Register/Register.hpp"
 
+#include <cstdint>
+
 namespace Kvasir::Core::Debug {
 
 using DCB_R = Kvasir::Peripheral::DCB::Registers<>;
+using DWT_R = Kvasir::Peripheral::DWT::Registers<>;
 
 // Returns true if a debugger has enabled halting debug (DHCSR.C_DEBUGEN).
 // This bit is set by the debugger over SWD when it attaches; software can only read it.
@@ -14,4 +18,28 @@ using DCB_R = Kvasir::Peripheral::DCB::Registers<>;
     return get<0>(apply(read(DCB_R::DHCSR::c_debugen))) != 0u;
 }
 
+namespace CycleCounter {
+    // Starts DWT.CYCCNT. DEMCR.TRCENA gates the whole DWT block and is usually left off
+    // when no debugger is attached, so it has to be set first.
+    static inline void enable() {
+        using Kvasir::Register::apply;
+        using Kvasir::Register::write;
+        apply(write(DCB_R::DEMCR::trcena, Kvasir::Register::value<1>()));
+        apply(write(DWT_R::CTRL::CYCCNTENAValC::enabled));
+    }
+
+    [[nodiscard]] static inline bool isImplemented() {
+        using Kvasir::Register::apply;
+        using Kvasir::Register::read;
+        return get<0>(apply(read(DWT_R::CTRL::nocyccnt))) == 0u;
+    }
+
+    // Free running core cycle count, wraps every 2^32 cycles.
+    [[nodiscard]] static inline std::uint32_t now() {
+        using Kvasir::Register::apply;
+        using Kvasir::Register::read;
+        return get<0>(apply(read(DWT_R::CYCCNT::cyccnt)));
+    }
+}   // namespace CycleCounter
+
 }   // namespace Kvasir::Core::Debug
@@ -1,4 +1,5 @@
 #pragma once
+#include "Backtrace.hpp"
 #include "core_peripherals/SCB.hpp"
 #include "kvasir/Register/Register.hpp"
 #include "kvasir/Util/StaticString.hpp"
@@ -239,4 +240,12 @@ static inline void Log([[maybe_unused]] std::uint32_t const* stack_ptr,
       lr_value);
 }
 
+template<std::size_t MaxDepth>
+static inline void LogBacktrace([[maybe_unused]] Backtrace<MaxDepth> const& trace) {
+    for(std::size_t i = 0; i < trace.depth; ++i) {
+        UC_LOG_C("COREFAULT backtrace #{} {:#010x}", i, trace.addresses[i]);
+    }
+    UC_LOG_C("COREFAULT backtrace depth({}) stop({})", trace.depth, trace.stop);
+}
+
 }   // namespace Kvasir::Core::Fault
@@ -8,12 +8,19 @@
 #include "kvasir/Register/Register.hpp"
 
 #include <algorithm>
+#include <cstddef>
 
 namespace Kvasir { namespace Nvic {
     namespace Detail {
         using namespace Register;
         using NvicRegs = Kvasir::Peripheral::NVIC::Registers<>;
 
+        // ISER/ICER/ITNS and IPR words backing the chip's implemented interrupts
+        static constexpr std::size_t enableWords
+          = (static_cast<std::size_t>(InterruptOffsetTraits<void>::end) + 31) / 32;
+        static constexpr std::size_t priorityWords
+          = (static_cast<std::size_t>(InterruptOffsetTraits<void>::end) + 3) / 4;
+
         template<typename InputIt>
         constexpr bool interuptIndexValid(int     Interrupt,
                                           InputIt f,
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "Nvic.hpp"
+#include "core_peripherals/SCB.hpp"
+#include "kvasir/Register/Register.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace Kvasir::Core::PowerState {
+
+namespace detail {
+    using SCB_R = Kvasir::Peripheral::SCB::Registers<>;
+
+    static constexpr std::size_t enableWords   = Nvic::Detail::enableWords;
+    static constexpr std::size_t priorityWords = Nvic::Detail::priorityWords;
+
+    using Words = std::array<std::uint32_t, enableWords>;
+
+    // Whole word views of ISER, ITNS and IPR so each word is one access, the generated NVIC
+    // model only has the per interrupt fields. Base and offsets as in core.svd.
+    static constexpr std::uintptr_t nvicBase = 0xE000E100;
+
+    template<std::uintptr_t Offset,
+             std::size_t    I>
+    using NvicWord = Register::FieldLocation<Register::Address<nvicBase + Offset + 4 * I>,
+                                             Register::maskFromRange(31, 0),
+                                             Register::ReadWriteAccess,
+                                             std::uint32_t>;
+
+    template<std::size_t I>
+    static constexpr NvicWord<0x000, I> iser{};
+    template<std::size_t I>
+    static constexpr NvicWord<0x280, I> itns{};
+    template<std::size_t I>
+    static constexpr NvicWord<0x300, I> ipr{};
+
+    template<std::size_t... Is>
+    static inline Words readEnables(std::index_sequence<Is...>) {
+        return {std::uint32_t(apply(read(iser<Is>)))...};
+    }
+
+    template<std::size_t... Is>
+    static inline void writeEnables(Words const& w,
+                                    std::index_sequence<Is...>) {
+        (apply(write(iser<Is>, w[Is])), ...);
+    }
+
+    template<std::size_t... Is>
+    static inline Words readTargets(std::index_sequence<Is...>) {
+        return {std::uint32_t(apply(read(itns<Is>)))...};
+    }
+
+    template<std::size_t... Is>
+    static inline void writeTargets(Words const& w,
+                                    std::index_sequence<Is...>) {
+        (apply(write(itns<Is>, w[Is])), ...);
+    }
+
+    template<std::size_t... Is>
+    static inline std::array<std::uint32_t, priorityWords>
+    readPriorities(std::index_sequence<Is...>) {
+        return {std::uint32_t(apply(read(ipr<Is>)))...};
+    }
+
+    template<std::size_t... Is>
+    static inline void writePriorities(std::array<std::uint32_t, priorityWords> const& w,
+                                       std::index_sequence<Is...>) {
+        (apply(write(ipr<Is>, w[Is])), ...);
+    }
+
+    template<typename Tuple, std::size_t... Is>
+    static inline void store(std::uint8_t* to,
+                             Tuple const&  from,
+                             std::index_sequence<Is...>) {
+        ((to[Is] = static_cast<std::uint8_t>(get<Is>(from))), ...);
+    }
+
+    // Everything is configured before the interrupt enables are written back.
+    template<typename State,
+             typename F>
+    static void restore(State const& state,
+                        F&&          resumeClock) {
+        auto const& p = state.shpr;
+        auto const& c = state.ccr;
+        auto const& h = state.shcsr;
+
+        apply(write(SCB_R::VTOR::tbloff, state.vtor));
+        apply(write(SCB_R::CCR::stkofhfnmign, c[0]),
+              write(SCB_R::CCR::bfhfnmign, c[1]),
+              write(SCB_R::CCR::div_0_trp, c[2]),
+              write(SCB_R::CCR::unalign_trp, c[3]),
+              write(SCB_R::CCR::usersetmpend, c[4]));
+        apply(write(SCB_R::SHPR1::pri_4, p[0]),
+              write(SCB_R::SHPR1::pri_5, p[1]),
+              write(SCB_R::SHPR1::pri_6, p[2]),
+              write(SCB_R::SHPR1::pri_7, p[3]));
+        apply(write(SCB_R::SHPR2::pri_8, p[4]),
+              write(SCB_R::SHPR2::pri_9, p[5]),
+              write(SCB_R::SHPR2::pri_10, p[6]),
+              write(SCB_R::SHPR2::pri_11, p[7]));
+        apply(write(SCB_R::SHPR3::pri_12, p[8]),
+              write(SCB_R::SHPR3::pri_13, p[9]),
+              write(SCB_R::SHPR3::pri_14, p[10]),
+              write(SCB_R::SHPR3::pri_15, p[11]));
+        writePriorities(state.ipr, std::make_index_sequence<priorityWords>{});
+        writeTargets(state.itns, std::make_index_sequence<enableWords>{});
+        apply(write(SCB_R::SHCSR::memfaultena, h[0]),
+              write(SCB_R::SHCSR::busfaultena, h[1]),
+              write(SCB_R::SHCSR::usgfaultena, h[2]),
+              write(SCB_R::SHCSR::securefaultena, h[3]));
+        resumeClock();
+        writeEnables(state.iser, std::make_index_sequence<enableWords>{});
+    }
+}   // namespace detail
+
+// Core interrupt and Systick configuration, meant to live in retained RAM while the core
+// power domain is off. Only configuration is kept: SHCSR active/pending bits are exception
+// state, and CCR cache enables need an invalidate first, so both are left to their owners.
+// ITNS is RAZ/WI from the Non-secure state, saving it there is harmless.
+template<typename Clock>
+struct CoreState {
+    std::array<std::uint32_t, detail::enableWords>   iser;
+    std::array<std::uint32_t, detail::enableWords>   itns;
+    std::array<std::uint32_t, detail::priorityWords> ipr;
+    std::array<std::uint8_t, 12>                     shpr;   // PRI_4 .. PRI_15
+    std::array<std::uint8_t, 4>                      shcsr;  // MEM/BUS/USG/SECUREFAULTENA
+    std::array<std::uint8_t, 5>                      ccr;    // trap and ignore bits
+    std::uint32_t                                    vtor;
+    typename Clock::time_point                       systick;
+    std::size_t                                      clockIndex;
+    bool                                             systickInterrupt;
+};
+
+// Call last before entering deep sleep, Systick is stopped afterwards.
+template<typename Clock>
+static void save(CoreState<Clock>& state) {
+    using detail::SCB_R;
+    state.iser = detail::readEnables(std::make_index_sequence<detail::enableWords>{});
+    state.itns = detail::readTargets(std::make_index_sequence<detail::enableWords>{});
+    state.ipr  = detail::readPriorities(std::make_index_sequence<detail::priorityWords>{});
+
+    detail::store(state.shpr.data(),
+                  apply(read(SCB_R::SHPR1::pri_4),
+                        read(SCB_R::SHPR1::pri_5),
+                        read(SCB_R::SHPR1::pri_6),
+                        read(SCB_R::SHPR1::pri_7)),
+                  std::make_index_sequence<4>{});
+    detail::store(state.shpr.data() + 4,
+                  apply(read(SCB_R::SHPR2::pri_8),
+                        read(SCB_R::SHPR2::pri_9),
+                        read(SCB_R::SHPR2::pri_10),
+                        read(SCB_R::SHPR2::pri_11)),
+                  std::make_index_sequence<4>{});
+    detail::store(state.shpr.data() + 8,
+                  apply(read(SCB_R::SHPR3::pri_12),
+                        read(SCB_R::SHPR3::pri_13),
+                        read(SCB_R::SHPR3::pri_14),
+                        read(SCB_R::SHPR3::pri_15)),
+                  std::make_index_sequence<4>{});
+    detail::store(state.shcsr.data(),
+                  apply(read(SCB_R::SHCSR::memfaultena),
+                        read(SCB_R::SHCSR::busfaultena),
+                        read(SCB_R::SHCSR::usgfaultena),
+                        read(SCB_R::SHCSR::securefaultena)),
+                  std::make_index_sequence<4>{});
+    detail::store(state.ccr.data(),
+                  apply(read(SCB_R::CCR::stkofhfnmign),
+                        read(SCB_R::CCR::bfhfnmign),
+                        read(SCB_R::CCR::div_0_trp),
+                        read(SCB_R::CCR::unalign_trp),
+                        read(SCB_R::CCR::usersetmpend)),
+                  std::make_index_sequence<5>{});
+    state.vtor             = apply(read(SCB_R::VTOR::tbloff));
+    state.clockIndex       = Clock::clockSpeedIndex();
+    state.systickInterrupt = Clock::interruptEnabled();
+    state.systick          = Clock::suspend();
+}
+
+// Replaces the Nvic, Fault::EarlyInitList and Systick init steps on wake from a power loss,
+// which leaves all these registers at their reset values. elapsed is the sleep time measured
+// by the wake source and moves Clock::now() forward. The core clock has to be back at
+// clockSpeed, or at clockSpeeds[ClockIndex] for the second form; state.clockIndex is the speed
+// it ran at before and can be returned to with Clock::changeClock afterwards.
+template<typename Clock,
+         typename Rep,
+         typename Period>
+static void restore(CoreState<Clock> const&            state,
+                    std::chrono::duration<Rep, Period> elapsed) {
+    detail::restore(state,
+                    [&] { Clock::resume(state.systick, elapsed, state.systickInterrupt); });
+}
+
+template<std::size_t ClockIndex,
+         typename Clock,
+         typename Rep,
+         typename Period>
+static void restore(CoreState<Clock> const&            state,
+                    std::chrono::duration<Rep, Period> elapsed) {
+    detail::restore(state,
+                    [&] {
+                        Clock::template resume<ClockIndex>(state.systick,
+                                                           elapsed,
+                                                           state.systickInterrupt);
+                    });
+}
+
+}   // namespace Kvasir::Core::PowerState
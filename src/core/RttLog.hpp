@@ -0,0 +1,152 @@
+#pragma once
+#include "Debug.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace Kvasir::Core::Debug {
+
+enum class OverflowPolicy : std::uint8_t { Drop, Overwrite };
+
+// Log channels in a SEGGER RTT compatible control block. A debug probe finds the block by
+// scanning RAM for its id and drains the ring buffers in the background while the core keeps
+// running. Each channel must only be written from one context (single writer); the probe is
+// the only reader.
+template<typename TConfig>
+struct RttLog {
+private:
+    // needed config
+    // channels
+    // bufferSize
+    // policy
+    // optional: names (std::array<char const*, channels>)
+    using Config                           = TConfig;
+    static constexpr std::size_t    Channels = Config::channels;
+    static constexpr std::size_t    Size     = Config::bufferSize;
+    static constexpr OverflowPolicy Policy   = Config::policy;
+
+    static_assert(Channels != 0, "need at least one channel");
+    static_assert(Size >= 2, "ring buffer needs room for at least one byte");
+
+    // layout is fixed by the probe side, all fields 32 bit on target
+    struct Buffer {
+        char const*            name;
+        std::byte*             buffer;
+        std::uint32_t          size;
+        std::uint32_t volatile wrOff;
+        std::uint32_t volatile rdOff;   // written by the probe
+        std::uint32_t          flags;
+    };
+
+    struct ControlBlock {
+        char volatile                id[16];
+        std::int32_t                 maxUpBuffers;
+        std::int32_t                 maxDownBuffers;
+        std::array<Buffer, Channels> up;
+    };
+
+    static inline ControlBlock                                      control{};
+    static inline std::array<std::array<std::byte, Size>, Channels> storage{};
+    // Reading DHCSR clears its sticky S_RESET_ST/S_RETIRE_ST bits which the probe relies on,
+    // so it is only read by init() and refresh(), never per record.
+    static inline bool attached{};
+
+    static constexpr char const* name(std::size_t channel) {
+        if constexpr(requires { Config::names; }) {
+            return Config::names[channel];
+        } else {
+            return channel == 0 ? "Terminal" : "";
+        }
+    }
+
+    static void copyIn(Buffer&                    b,
+                       std::uint32_t              wr,
+                       std::span<std::byte const> data) {
+        std::size_t const first = std::min<std::size_t>(data.size(), Size - wr);
+        std::copy_n(data.data(), first, b.buffer + wr);
+        std::copy_n(data.data() + first, data.size() - first, b.buffer);
+    }
+
+public:
+    // Fills the descriptors before the id so a probe scanning RAM never finds a half built
+    // block.
+    static void init() {
+        control.maxUpBuffers   = static_cast<std::int32_t>(Channels);
+        control.maxDownBuffers = 0;
+        for(std::size_t i = 0; i < Channels; ++i) {
+            control.up[i].name   = name(i);
+            control.up[i].buffer = storage[i].data();
+            control.up[i].size   = static_cast<std::uint32_t>(Size);
+            control.up[i].wrOff  = 0;
+            control.up[i].rdOff  = 0;
+            control.up[i].flags  = 0;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // written back to front so the full id only appears once everything else is in place
+        static constexpr std::string_view id{"SEGGER RTT\0\0\0\0\0", 16};
+        for(std::size_t i = id.size(); i != 0; --i) { control.id[i - 1] = id[i - 1]; }
+        std::atomic_thread_fence(std::memory_order_release);
+        refresh();
+    }
+
+    // Re-reads DHCSR.C_DEBUGEN, call periodically (or from the idle loop) to pick up a probe
+    // attached after init().
+    static void refresh() { attached = isDebuggerConnected(); }
+
+    // Cheap check to skip formatting a record nobody will read.
+    [[nodiscard]] static bool enabled() { return attached; }
+
+    // Appends one record to Channel without blocking. Returns false if the record was dropped,
+    // either because no debugger was attached at the last init()/refresh() (then nothing else
+    // is touched) or because it did not fit under OverflowPolicy::Drop. Under
+    // OverflowPolicy::Overwrite the oldest unread bytes are discarded instead; that moves the
+    // probe's read offset, so a concurrent probe read may see a partially overwritten record.
+    template<std::size_t Channel>
+    static bool write(std::span<std::byte const> data) {
+        static_assert(Channel < Channels, "channel out of range");
+        if(!enabled()) { return false; }
+        Buffer& b = control.up[Channel];
+        if(b.size == 0 || data.empty()) { return false; }
+
+        if(data.size() > Size - 1) {
+            if constexpr(Policy == OverflowPolicy::Drop) {
+                return false;
+            } else {
+                data = data.last(Size - 1);
+            }
+        }
+
+        std::uint32_t const wr    = b.wrOff;
+        std::uint32_t const rd    = b.rdOff;
+        std::size_t const   avail = rd > wr ? rd - wr - 1 : Size - (wr - rd) - 1;
+        auto const          len   = static_cast<std::uint32_t>(data.size());
+        std::uint32_t const newWr = (wr + len) % Size;
+
+        if(data.size() > avail) {
+            if constexpr(Policy == OverflowPolicy::Drop) {
+                return false;
+            } else {
+                b.rdOff = (newWr + 1) % Size;
+                std::atomic_thread_fence(std::memory_order_release);
+            }
+        }
+
+        copyIn(b, wr, data);
+        std::atomic_thread_fence(std::memory_order_release);
+        b.wrOff = newWr;
+        return true;
+    }
+
+    template<std::size_t Channel>
+    static bool write(std::string_view text) {
+        return write<Channel>(std::as_bytes(std::span{text.data(), text.size()}));
+    }
+};
+
+}   // namespace Kvasir::Core::Debug
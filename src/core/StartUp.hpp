@@ -1,4 +1,13 @@
 #pragma once
+#include "Debug.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <type_traits>
+
 extern "C" {
 extern void _LINKER_stack_start_();
 }
@@ -7,4 +16,164 @@ namespace Kvasir::Startup::Core {
 
 static void startup() { asm("msr MSPLIM, %0" : : "r"(_LINKER_stack_start_)); }
 
+// Section bounds as provided by the linker script, word aligned.
+struct DataSection {
+    std::uint32_t*       begin;
+    std::uint32_t*       end;
+    std::uint32_t const* load;
+};
+
+struct BssSection {
+    std::uint32_t* begin;
+    std::uint32_t* end;
+};
+
+// Runs before .data/.bss exist, so these must not turn into memcpy/memset calls.
+// Four words per iteration lets the compiler use ldm/stm, the tail is copied word wise.
+[[clang::no_builtin]] static inline void copyWords(std::uint32_t*       dst,
+                                                   std::uint32_t*       end,
+                                                   std::uint32_t const* src) {
+    while(end - dst >= 4) {
+        std::uint32_t const a = src[0];
+        std::uint32_t const b = src[1];
+        std::uint32_t const c = src[2];
+        std::uint32_t const d = src[3];
+        dst[0]                = a;
+        dst[1]                = b;
+        dst[2]                = c;
+        dst[3]                = d;
+        dst += 4;
+        src += 4;
+    }
+    while(dst != end) { *dst++ = *src++; }
+}
+
+[[clang::no_builtin]] static inline void zeroWords(std::uint32_t* dst,
+                                                   std::uint32_t* end) {
+    while(end - dst >= 4) {
+        dst[0] = 0;
+        dst[1] = 0;
+        dst[2] = 0;
+        dst[3] = 0;
+        dst += 4;
+    }
+    while(dst != end) { *dst++ = 0; }
+}
+
+struct BootStep {
+    char const*   name;
+    std::uint32_t cycles;
+};
+
+// Cycle timestamps for each boot step, kept after boot for inspection (debugger or log).
+// The state lives in .noinit because the first steps run before .bss is zeroed; the
+// section has to be NOLOAD and excluded from the .bss range. MaxSteps == 0 compiles the
+// measurement out and only runs the steps. On parts without a cycle counter
+// (DWT_CTRL.NOCYCCNT) nothing is recorded and valid() is false.
+template<std::size_t MaxSteps>
+struct BootLog {
+    static void begin() {
+        if constexpr(MaxSteps != 0) {
+            count = 0;
+            start = 0;
+            last  = 0;
+            Kvasir::Core::Debug::CycleCounter::enable();
+            // NOCYCCNT is only meaningful once TRCENA is set
+            counting = Kvasir::Core::Debug::CycleCounter::isImplemented();
+            if(!counting) { return; }
+            start = Kvasir::Core::Debug::CycleCounter::now();
+            last  = start;
+        }
+    }
+
+    // Records the cycles spent since the previous mark (or begin).
+    static void mark(char const* name) {
+        if constexpr(MaxSteps != 0) {
+            if(!counting) { return; }
+            std::uint32_t const now = Kvasir::Core::Debug::CycleCounter::now();
+            if(count < MaxSteps) {
+                log[count] = BootStep{name, now - last};
+                ++count;
+            }
+            last = now;
+        }
+    }
+
+    template<typename F>
+    static void step(char const* name,
+                     F&&         f) {
+        f();
+        mark(name);
+    }
+
+    // false if the part has no cycle counter, steps() is empty then
+    [[nodiscard]] static bool valid() {
+        if constexpr(MaxSteps != 0) {
+            return counting;
+        } else {
+            return false;
+        }
+    }
+
+    [[nodiscard]] static std::span<BootStep const> steps() {
+        if constexpr(MaxSteps != 0) {
+            return {log.data(), count};
+        } else {
+            return {};
+        }
+    }
+
+    [[nodiscard]] static std::uint32_t total() {
+        if constexpr(MaxSteps != 0) {
+            return last - start;
+        } else {
+            return 0;
+        }
+    }
+
+private:
+    [[gnu::section(".noinit")]] static inline std::array<BootStep, MaxSteps> log;
+    [[gnu::section(".noinit")]] static inline std::size_t                    count;
+    [[gnu::section(".noinit")]] static inline std::uint32_t                  start;
+    [[gnu::section(".noinit")]] static inline std::uint32_t                  last;
+    [[gnu::section(".noinit")]] static inline bool                           counting;
+};
+
+// Staged memory bring-up: stack limit, .data copy, .bss zeroing, each step timed into Log.
+template<typename Log = BootLog<0>>
+static void initMemory(DataSection const& data,
+                       BssSection const&  bss) {
+    Log::begin();
+    Log::step("stack", [] { startup(); });
+    Log::step("data", [&] { copyWords(data.begin, data.end, data.load); });
+    Log::step("bss", [&] { zeroWords(bss.begin, bss.end); });
+}
+
+// Large zero initialized buffer that is kept out of .bss so the boot path does not pay for
+// clearing it. The storage sits in .noinit and is zeroed on the first call to get().
+// Not safe to first-touch concurrently from thread and ISR context.
+template<typename T,
+         typename Tag = void>
+struct DeferredZero {
+    static_assert(std::is_trivial_v<T>, "zeroed storage only makes sense for trivial types");
+
+    static T& get() {
+        if(!initialized) {
+            zeroWords(storage.data(), storage.data() + storage.size());
+            initialized = true;
+        }
+        return *std::launder(reinterpret_cast<T*>(storage.data()));
+    }
+
+private:
+    static constexpr std::size_t words = (sizeof(T) + sizeof(std::uint32_t) - 1)
+                                       / sizeof(std::uint32_t);
+
+    [[gnu::section(".noinit")]] alignas(
+      alignof(T) > alignof(std::uint32_t) ? alignof(T)
+                                          : alignof(std::uint32_t)) static inline std::
+      array<std::uint32_t, words> storage;
+    static inline bool initialized{};
+};
+
 }   // namespace Kvasir::Startup::Core
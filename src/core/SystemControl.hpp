@@ -14,7 +14,24 @@ namespace SystemControl {
     using SystemReset = decltype(Kvasir::Peripheral::SCB::Registers<>::AIRCR::overrideDefaults(
       write(Kvasir::Peripheral::SCB::Registers<>::AIRCR::VECTKEYValC::request_reset),
       write(Kvasir::Peripheral::SCB::Registers<>::AIRCR::SYSRESETREQValC::request_reset)));
-}
+
+    // Masks all configurable interrupts (PRIMASK) for its lifetime, restores the previous mask
+    // so it nests.
+    struct InterruptLock {
+        InterruptLock() {
+            asm volatile("mrs %0, primask" : "=r"(primask));
+            asm volatile("cpsid i" ::: "memory");
+        }
+
+        ~InterruptLock() { asm volatile("msr primask, %0" : : "r"(primask) : "memory"); }
+
+        InterruptLock(InterruptLock const&)            = delete;
+        InterruptLock& operator=(InterruptLock const&) = delete;
+
+    private:
+        std::uint32_t primask;
+    };
+}   // namespace SystemControl
 
 namespace Nvic {
 
@@ -8,8 +8,13 @@
 #include "kvasir/Register/Register.hpp"
 #include "kvasir/Register/Utility.hpp"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <numeric>
+#include <optional>
+#include <type_traits>
 
 namespace Kvasir {
 namespace Systick {
@@ -64,9 +69,32 @@ namespace Systick {
         // clockSpeed
         // clockBase
         // minOverrunTime
+        // optional: clockSpeeds (std::array<std::uint64_t, N>) for runtime clock changes,
+        //           must contain clockSpeed which is the speed after init and the unit of duration
+        //           clockSwitchTime, upper bound of a switch, needed by changeClock if setClock
+        //           does not return the measured time
         using Config                              = TConfig;
         static constexpr std::uint64_t ClockSpeed = Config::clockSpeed;
         using Regs                                = Kvasir::Peripheral::SYSTICK::Registers<>;
+        using ScbRegs                             = Kvasir::Peripheral::SCB::Registers<>;
+
+        static constexpr bool Dvfs          = requires { Config::clockSpeeds; };
+        static constexpr bool HasSwitchTime = requires { Config::clockSwitchTime; };
+
+        static constexpr auto ClockSpeeds = [] {
+            if constexpr(Dvfs) {
+                return Config::clockSpeeds;
+            } else {
+                return std::array<std::uint64_t, 1>{ClockSpeed};
+            }
+        }();
+
+        static constexpr std::uint64_t MaxClockSpeed
+          = *std::max_element(ClockSpeeds.begin(), ClockSpeeds.end());
+
+        static constexpr std::size_t NominalClock = static_cast<std::size_t>(
+          std::find(ClockSpeeds.begin(), ClockSpeeds.end(), ClockSpeed) - ClockSpeeds.begin());
+        static_assert(NominalClock != ClockSpeeds.size(), "clockSpeeds has to contain clockSpeed");
 
     public:
         // chrono interface
@@ -104,10 +132,24 @@ namespace Systick {
         }
 
     private:
-        static_assert(Config::clockSpeed
-                        < std::numeric_limits<std::uint64_t>::max() / 100'000'000ULL,
+        static_assert(MaxClockSpeed < std::numeric_limits<std::uint64_t>::max() / 100'000'000ULL,
                       "ClockSpeed to high");
 
+        // counter ticks at ClockSpeeds[i] to duration ticks, as reduced fraction num / den
+        struct Scale {
+            std::uint64_t num;
+            std::uint64_t den;
+        };
+
+        static constexpr auto Scales = [] {
+            std::array<Scale, ClockSpeeds.size()> scales{};
+            for(std::size_t i = 0; i < ClockSpeeds.size(); ++i) {
+                std::uint64_t const g = std::gcd(ClockSpeed, ClockSpeeds[i]);
+                scales[i]             = Scale{ClockSpeed / g, ClockSpeeds[i] / g};
+            }
+            return scales;
+        }();
+
         template<std::uint64_t OverRunValue, typename = void>
         struct GetOverrunType {
             using type = std::uint64_t;
@@ -137,8 +179,20 @@ namespace Systick {
                  / NanoSecPerOverrun;
         }
 
-        using overrunT = GetOverrunTypeT<calcOverRunValue(ClockSpeed, Config::minOverrunTime)>;
+        using overrunT
+          = GetOverrunTypeT<calcOverRunValue(MaxClockSpeed, Config::minOverrunTime)>;
         static inline std::atomic<overrunT> overruns{};
+        // offset added to the counter derived time, moved forward when resuming from a power
+        // loss and captured on every clock change; only written while the counter is stopped
+        static inline rep timeBase{};
+        static inline std::size_t clockIndex{NominalClock};
+
+        // splits the multiplication so ticks * num can not overflow
+        static constexpr std::uint64_t scaleTicks(std::uint64_t ticks,
+                                                  Scale         s) {
+            if(s.den == 1) { return ticks * s.num; }
+            return (ticks / s.den) * s.num + ((ticks % s.den) * s.num) / s.den;
+        }
 
         static void onIsr() {
             overrunT old = overruns.load(std::memory_order_relaxed);
@@ -179,8 +233,129 @@ namespace Systick {
             auto const cnd  = duration{reloadValue - currentCount};
             auto const ovd  = duration{static_cast<std::uint64_t>(localOverruns)
                                        * static_cast<std::uint64_t>(reloadValue + 1)};
-            auto const time = time_point{cnd + ovd};
-            return time;
+            if constexpr(Dvfs) {
+                auto const ticks = static_cast<std::uint64_t>((cnd + ovd).count());
+                return time_point{
+                  duration{timeBase + rep(scaleTicks(ticks, Scales[clockIndex]))}};
+            } else {
+                auto const time = time_point{duration{timeBase} + cnd + ovd};
+                return time;
+            }
+        }
+
+        // Switches the core clock to ClockSpeeds[Index] by calling setClock and keeps now()
+        // monotonic in duration units: the time is captured as new base and the counter restarts
+        // at the new speed. The counter is stopped while setClock runs; that time is taken from
+        // the duration setClock returns if it measures it, otherwise from
+        // Config::clockSwitchTime.
+        template<std::size_t Index,
+                 typename F>
+        static void changeClock(F&& setClock)
+            requires Dvfs
+        {
+            static_assert(Index < ClockSpeeds.size(), "clock index out of range");
+            static constexpr auto reloadValue = calcReloadValue(ClockSpeed);
+
+            SystemControl::InterruptLock const lock{};
+            apply(write(Regs::CSR::ENABLEValC::counter_is_disabled));
+
+            // With the counter stopped CVR and overruns are stable. A wrap whose isr is held
+            // off by the lock shows up as pending Systick instead; at CVR == 0 that wrap is the
+            // one just reached and is already part of the in-period count.
+            std::uint32_t const currentCount  = apply(read(Regs::CVR::current));
+            overrunT            localOverruns = overruns.load(std::memory_order_relaxed);
+            if(fieldEquals(ScbRegs::ICSR::PENDSTSETValC::set_pending)) {
+                if(currentCount != 0) { ++localOverruns; }
+                apply(action(Nvic::Action::clearPending, Interrupt::systick));
+            }
+            std::uint64_t const ticks
+              = localOverruns * (std::uint64_t(reloadValue) + 1) + (reloadValue - currentCount);
+            rep base = timeBase + rep(scaleTicks(ticks, Scales[clockIndex]));
+
+            if constexpr(std::is_void_v<decltype(setClock())>) {
+                static_assert(HasSwitchTime,
+                              "setClock does not return the time it took, config needs "
+                              "clockSwitchTime");
+                setClock();
+                if constexpr(HasSwitchTime) {
+                    base += std::chrono::duration_cast<duration>(Config::clockSwitchTime).count();
+                }
+            } else {
+                base += std::chrono::duration_cast<duration>(setClock()).count();
+            }
+
+            clockIndex = Index;
+            overruns.store(0, std::memory_order_relaxed);
+            timeBase = base;
+            apply(write(Regs::CVR::current, Register::value<0>()));
+            apply(write(Regs::CSR::ENABLEValC::counter_is_operating));
+            while(apply(read(Regs::CVR::current)) == 0) {}
+        }
+
+        [[nodiscard]] static std::uint64_t clockSpeed() { return ClockSpeeds[clockIndex]; }
+
+        // entry of clockSpeeds now() currently counts at, to be kept across a power loss
+        [[nodiscard]] static std::size_t clockSpeedIndex() { return clockIndex; }
+
+        // Cross checks clockSpeed against SYST_CALIB.TENMS (ticks per 10ms - 1). TENMS is fixed
+        // by the part and describes one speed, so this is only meaningful on parts whose TENMS
+        // is for the Systick clock source selected by clockBase at clockSpeed, whatever speed
+        // changeClock switched to since. Empty if the part gives no usable value: TENMS zero,
+        // inexact (SKEW) or no reference clock (NOREF).
+        [[nodiscard]] static std::optional<bool> calibrationMatches() {
+            auto const calib = apply(read(Regs::SYST_CALIB::noref),
+                                     read(Regs::SYST_CALIB::skew),
+                                     read(Regs::SYST_CALIB::tenms));
+            auto const tenms = static_cast<std::uint32_t>(get<2>(calib));
+            if(static_cast<std::uint32_t>(get<0>(calib)) != 0
+               || static_cast<std::uint32_t>(get<1>(calib)) != 0 || tenms == 0)
+            {
+                return std::nullopt;
+            }
+            // exact up to the 10ms granularity, so within one TENMS step
+            std::uint64_t const measured = (std::uint64_t(tenms) + 1) * 100;
+            std::uint64_t const diff
+              = measured > ClockSpeed ? measured - ClockSpeed : ClockSpeed - measured;
+            return diff < 100;
+        }
+
+        // TICKINT, to be kept across a power loss together with the time from suspend()
+        [[nodiscard]] static bool interruptEnabled() {
+            return fieldEquals(Regs::CSR::TICKINTValC::interrupt_enabled);
+        }
+
+        // Stops the counter and returns the time to keep in retained RAM across a power loss.
+        static time_point suspend() {
+            time_point const t = now();
+            apply(write(Regs::CSR::ENABLEValC::counter_is_disabled));
+            return t;
+        }
+
+        // Restarts the counter after a power loss so that now() continues at
+        // suspended + elapsed. elapsed has to come from a source that kept running through the
+        // sleep (RTC, low power timer). Call before interrupts are enabled again.
+        // Index is the entry of clockSpeeds the core runs at after wake, by default clockSpeed
+        // which the clock has to be reinitialized to before. The speed before the power loss is
+        // not restored, use changeClock to go back to it. The Systick interrupt is only enabled
+        // again if tickInterrupt, the interruptEnabled() from before the power loss, says so.
+        template<std::size_t Index = NominalClock,
+                 typename Rep,
+                 typename Period>
+        static void resume(time_point                          suspended,
+                           std::chrono::duration<Rep, Period> elapsed,
+                           bool                               tickInterrupt) {
+            static_assert(Index < ClockSpeeds.size(), "clock index out of range");
+            apply(initStepPeripheryConfig);
+            clockIndex = Index;
+            overruns.store(0, std::memory_order_relaxed);
+            timeBase = (suspended + std::chrono::duration_cast<duration>(elapsed))
+                         .time_since_epoch()
+                         .count();
+            apply(write(Regs::CSR::ENABLEValC::counter_is_operating));
+            if(tickInterrupt) { apply(makeEnable(Interrupt::systick)); }
+            // CVR starts at 0 and reloads on the first tick without counting down, wait for
+            // that so now() does not read a full period too far ahead
+            while(apply(read(Regs::CVR::current)) == 0) {}
         }
 
         template<typename Duration,
@@ -189,7 +364,11 @@ namespace Systick {
             static constexpr auto reloadValue = calcReloadValue(ClockSpeed);
             static constexpr auto ticksToWait
               = std::chrono::duration_cast<duration>(Duration{value}).count();
-            if constexpr(ticksToWait >= reloadValue) {
+            if constexpr(Dvfs) {
+                // counter ticks per duration tick depend on the current clock
+                time_point const end = now() + duration{ticksToWait};
+                while(now() < end) {}
+            } else if constexpr(ticksToWait >= reloadValue) {
                 static constexpr auto count
                   = std::uint32_t(double(ticksToWait) / double(reloadValue));
                 static constexpr auto last
@@ -1,14 +1,19 @@
 #pragma once
 
 #include "core_peripherals/CMO.hpp"
+#include "core_peripherals/DCB.hpp"
+#include "core_peripherals/DWT.hpp"
 #include "core_peripherals/NVIC.hpp"
 #include "core_peripherals/SCB.hpp"
 #include "core_peripherals/SYSTICK.hpp"
 
 //
 #include "CoreInterrupts.hpp"
+#include "Coroutine.hpp"
 #include "Debug.hpp"
 #include "Nvic.hpp"
+#include "PowerState.hpp"
+#include "RttLog.hpp"
 #include "StartUp.hpp"
 #include "SystemControl.hpp"
 #include "Systick.hpp"